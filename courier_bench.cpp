@@ -0,0 +1,307 @@
+// Micro-benchmarks for the core data structures and planners (courier_core.h).
+// Every case uses fixed seeds, reports ns/op and allocations/op, and the whole run is saved as JSON so results
+// can be diffed across commits:
+//   courier_bench [--json out.json] [--baseline old.json] [--filter name] [--reps N] [--quick]
+#include "courier_core.h"
+#include <new>
+
+// ------------- Allocation counting -------------
+// Every operator new in the process (std::string buffers included) bumps these; the core's own
+// METRIC alloc_* counters are reported next to them as "core_allocs".
+static atomic<unsigned long long> gAllocCount(0), gAllocBytes(0);
+
+// GCC 11+ inlines these into new[]/delete[] call sites and then misreads the malloc/free pairs inside them as
+// mismatched; the diagnostic is reported in the operator bodies, so it is silenced here only
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(size_t n) {
+    gAllocCount.fetch_add(1, memory_order_relaxed); gAllocBytes.fetch_add(n, memory_order_relaxed);
+    void* p = malloc(n ? n : 1); if (!p) throw bad_alloc(); return p;
+}
+void* operator new[](size_t n) {
+    gAllocCount.fetch_add(1, memory_order_relaxed); gAllocBytes.fetch_add(n, memory_order_relaxed);
+    void* p = malloc(n ? n : 1); if (!p) throw bad_alloc(); return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+static unsigned long long coreAllocs() {
+    unsigned long long m[M_COUNT]; MetricRegistry::instance().snapshot(m);
+    unsigned long long s = 0; for (int i = M_ALLOC_PARCEL; i <= M_ALLOC_ROUTING; ++i) s += m[i];
+    return s;
+}
+
+// ------------- Harness -------------
+// A case builds its input untimed and brackets the measured part with start()/stop(); stop() may be called
+// more than once per rep (the parts add up). ops is what the ns and allocation totals are divided by.
+class BenchClock {
+public:
+    chrono::steady_clock::time_point t0; unsigned long long a0, b0, c0;
+    double ns; unsigned long long allocs, bytes, core;
+    BenchClock() : a0(0), b0(0), c0(0), ns(0), allocs(0), bytes(0), core(0) {}
+    void start() { a0 = gAllocCount.load(); b0 = gAllocBytes.load(); c0 = coreAllocs(); t0 = chrono::steady_clock::now(); }
+    void stop() {
+        ns += (double)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - t0).count();
+        allocs += gAllocCount.load() - a0; bytes += gAllocBytes.load() - b0; core += coreAllocs() - c0;
+    }
+};
+
+typedef long long (*BenchFn)(BenchClock& clk, int n, unsigned int seed); // returns ops for this rep
+
+class BenchCase { public: const char* name; BenchFn fn; int n; };
+
+class BenchResult {
+public:
+    string name; int n; long long ops; double nsMedian, nsMin; double allocsPerOp, bytesPerOp, coreAllocsPerOp;
+    BenchResult() : n(0), ops(0), nsMedian(0), nsMin(0), allocsPerOp(0), bytesPerOp(0), coreAllocsPerOp(0) {}
+};
+
+static volatile long long gSink = 0; // results feed this so the optimiser keeps the work
+
+static const unsigned int BENCH_SEED = 20240601u;
+
+static string benchId(int i) { return to_string(100000000 + i); }
+
+static Parcel** makeParcels(int n, unsigned int seed) {
+    static const char* zones[6] = { "Lahore", "Karachi", "Peshawar", "Quetta", "Islamabad", "Gujranwala" };
+    Parcel** ps = new Parcel * [n];
+    for (int i = 0; i < n; ++i) {
+        int d = (int)(benchRand(seed) % 6);
+        ps[i] = new Parcel(benchId(i), "bench", "bench", zones[0], zones[d], 0.2 + (benchRand(seed) % 900) / 100.0, (int)(benchRand(seed) % 3), i);
+    }
+    return ps;
+}
+static void freeParcels(Parcel** ps, int n) { for (int i = 0; i < n; ++i) delete ps[i]; delete[] ps; }
+
+// Synthetic road network: a ring (always connected) plus random chords up to avgDegree, distances 5..500 km
+static void makeGraph(Graph& g, int V, int avgDegree, unsigned int seed) {
+    for (int i = 0; i < V; ++i) g.addCity(string("N") + to_string(i));
+    for (int i = 0; i < V; ++i) g.addUndirectedRoad(g.name[i], g.name[(i + 1) % V], 5 + (int)(benchRand(seed) % 496), (int)(benchRand(seed) % 60));
+    int extra = V * (avgDegree - 2) / 2;
+    for (int k = 0; k < extra; ++k) {
+        int u = (int)(benchRand(seed) % V), v = (int)(benchRand(seed) % V);
+        if (u == v || g.findEdge(u, v)) { continue; }
+        g.addUndirectedRoad(g.name[u], g.name[v], 5 + (int)(benchRand(seed) % 496), (int)(benchRand(seed) % 60));
+    }
+}
+
+// ------------- Cases -------------
+
+static long long benchHashPut(BenchClock& clk, int n, unsigned int seed) {
+    Parcel** ps = makeParcels(n, seed); ParcelHashTable t;
+    clk.start(); for (int i = 0; i < n; ++i) t.put(ps[i]->id, ps[i]); clk.stop();
+    gSink += t.sz; freeParcels(ps, n); return n;
+}
+static long long benchHashGetHit(BenchClock& clk, int n, unsigned int seed) {
+    Parcel** ps = makeParcels(n, seed); ParcelHashTable t; for (int i = 0; i < n; ++i) t.put(ps[i]->id, ps[i]);
+    string* keys = new string[n]; for (int i = 0; i < n; ++i) keys[i] = benchId((int)(benchRand(seed) % (unsigned int)n));
+    long long hit = 0;
+    clk.start(); for (int i = 0; i < n; ++i) if (t.get(keys[i])) ++hit; clk.stop();
+    gSink += hit; delete[] keys; freeParcels(ps, n); return n;
+}
+static long long benchHashGetMiss(BenchClock& clk, int n, unsigned int seed) {
+    Parcel** ps = makeParcels(n, seed); ParcelHashTable t; for (int i = 0; i < n; ++i) t.put(ps[i]->id, ps[i]);
+    string* keys = new string[n]; for (int i = 0; i < n; ++i) keys[i] = benchId(n + i);
+    long long hit = 0;
+    clk.start(); for (int i = 0; i < n; ++i) if (t.get(keys[i])) ++hit; clk.stop();
+    gSink += hit; delete[] keys; freeParcels(ps, n); return n;
+}
+static long long benchHashRemove(BenchClock& clk, int n, unsigned int seed) {
+    Parcel** ps = makeParcels(n, seed); ParcelHashTable t; for (int i = 0; i < n; ++i) t.put(ps[i]->id, ps[i]);
+    long long gone = 0;
+    clk.start(); for (int i = 0; i < n; ++i) if (t.remove(ps[i]->id)) ++gone; clk.stop();
+    gSink += gone; freeParcels(ps, n); return n;
+}
+static long long benchHeapPush(BenchClock& clk, int n, unsigned int seed) {
+    Parcel** ps = makeParcels(n, seed); ParcelMaxHeap h;
+    clk.start(); for (int i = 0; i < n; ++i) h.push(ps[i]); clk.stop();
+    gSink += h.size(); freeParcels(ps, n); return n;
+}
+static long long benchHeapPop(BenchClock& clk, int n, unsigned int seed) {
+    Parcel** ps = makeParcels(n, seed); ParcelMaxHeap h; for (int i = 0; i < n; ++i) h.push(ps[i]);
+    long long s = 0;
+    clk.start(); while (h.size() > 0) s += h.pop()->createSerial; clk.stop();
+    gSink += s; freeParcels(ps, n); return n;
+}
+static long long benchMergeSort(BenchClock& clk, int n, unsigned int seed) {
+    Parcel** ps = makeParcels(n, seed); ParcelList l; for (int i = 0; i < n; ++i) l.insertFront(ps[i]);
+    clk.start(); ParcelList::mergeSortNodes(&l.head, &ParcelList::cmpPriority); clk.stop();
+    gSink += l.head->val->createSerial; freeParcels(ps, n); return n;
+}
+// n = single-source queries; sources cycle over the vertices
+static long long benchDijkstra(BenchClock& clk, int n, unsigned int seed, int avgDegree) {
+    Graph g; makeGraph(g, Graph::MAXV, avgDegree, seed); DijkstraResult res; long long s = 0;
+    clk.start();
+    for (int i = 0; i < n; ++i) { dijkstra(g, i % g.V, res); s += res.dist[(i * 7 + 3) % g.V]; }
+    clk.stop();
+    gSink += s; return n;
+}
+static long long benchDijkstraSparse(BenchClock& clk, int n, unsigned int seed) { return benchDijkstra(clk, n, seed, 4); }
+static long long benchDijkstraDense(BenchClock& clk, int n, unsigned int seed) { return benchDijkstra(clk, n, seed, 16); }
+// n = (src, dst) queries for up to 3 routes each, through a reused RoutingWorkspace
+static long long benchAltRoutes(BenchClock& clk, int n, unsigned int seed) {
+    Graph g; makeGraph(g, Graph::MAXV, 6, seed); RoutingWorkspace ws; Path out[3]; long long s = 0;
+    int* src = new int[n]; int* dst = new int[n];
+    for (int i = 0; i < n; ++i) { src[i] = (int)(benchRand(seed) % g.V); dst[i] = (int)((src[i] + 1 + benchRand(seed) % (g.V - 1)) % g.V); }
+    clk.start(); for (int i = 0; i < n; ++i) s += collectAlternativeRoutes(ws, g, src[i], dst[i], out, 3); clk.stop();
+    gSink += s; delete[] src; delete[] dst; return n;
+}
+// n = parcels planned onto the seeded hubs by weight and volume, fleet a quarter larger than the wave
+static long long benchLoadPlan(BenchClock& clk, int n, unsigned int seed) {
+    CourierSystem sys; Parcel** ps = makeParcels(n, seed); double kg = 0, litres = 0;
+    for (int i = 0; i < n; ++i) { if (i % 4) ps[i]->volume = ps[i]->weight * (2 + benchRand(seed) % 8); kg += ps[i]->weight; litres += parcelLitres(ps[i]); }
+    int trucks = (int)ceil(1.25 * (kg / 4100.0 > litres / 28000.0 ? kg / 4100.0 : litres / 28000.0));
+    sys.setFleet(trucks, 2500, 18000, 2 * trucks, 800, 5000);
+    LoadPlan plan;
+    clk.start(); planLoads(sys.graph, ps, NULL, n, sys.fleet, sys.fleetCount, plan); clk.stop();
+    gSink += plan.nParcels + plan.nLoads; freeParcels(ps, n); return n;
+}
+static long long benchHistoryAdd(BenchClock& clk, int n, unsigned int) {
+    HistoryList h;
+    clk.start(); for (int i = 0; i < n; ++i) h.add("Dispatched to Warehouse"); clk.stop();
+    h.clear(); return n;
+}
+static long long benchQueuePush(BenchClock& clk, int n, unsigned int) {
+    string* ids = new string[n]; for (int i = 0; i < n; ++i) ids[i] = benchId(i);
+    StringQueue q;
+    clk.start(); for (int i = 0; i < n; ++i) q.push(ids[i]); clk.stop();
+    gSink += q.size(); delete[] ids; return n;
+}
+static long long benchQueuePop(BenchClock& clk, int n, unsigned int) {
+    StringQueue q; for (int i = 0; i < n; ++i) q.push(benchId(i));
+    string out; long long s = 0;
+    clk.start(); while (q.pop(out)) s += out.size(); clk.stop();
+    gSink += s; return n;
+}
+// Removal by id from random positions: the O(n) scan transitQ pays on cancel/archive
+static long long benchQueueRemove(BenchClock& clk, int n, unsigned int seed) {
+    StringQueue q; int* order = new int[n];
+    for (int i = 0; i < n; ++i) { q.push(benchId(i)); order[i] = i; }
+    for (int i = n - 1; i > 0; --i) { int j = (int)(benchRand(seed) % (unsigned int)(i + 1)); int t = order[i]; order[i] = order[j]; order[j] = t; }
+    string* ids = new string[n]; for (int i = 0; i < n; ++i) ids[i] = benchId(order[i]);
+    long long gone = 0;
+    clk.start(); for (int i = 0; i < n; ++i) if (q.remove(ids[i])) ++gone; clk.stop();
+    gSink += gone; delete[] ids; delete[] order; return n;
+}
+
+static const BenchCase CASES[] = {
+    { "hashtable_put", benchHashPut, 200000 },
+    { "hashtable_get_hit", benchHashGetHit, 200000 },
+    { "hashtable_get_miss", benchHashGetMiss, 200000 },
+    { "hashtable_remove", benchHashRemove, 200000 },
+    { "heap_push", benchHeapPush, 200000 },
+    { "heap_pop", benchHeapPop, 200000 },
+    { "merge_sort_nodes", benchMergeSort, 200000 },
+    { "dijkstra_v64_deg4", benchDijkstraSparse, 20000 },
+    { "dijkstra_v64_deg16", benchDijkstraDense, 20000 },
+    { "alternative_routes_v64_k3", benchAltRoutes, 5000 },
+    { "load_plan", benchLoadPlan, 100000 },
+    { "history_add", benchHistoryAdd, 100000 },
+    { "string_queue_push", benchQueuePush, 200000 },
+    { "string_queue_pop", benchQueuePop, 200000 },
+    { "string_queue_remove", benchQueueRemove, 5000 },
+};
+static const int NCASES = (int)(sizeof(CASES) / sizeof(CASES[0]));
+
+static void sortDoubles(double* a, int n) { for (int i = 1; i < n; ++i) { double x = a[i]; int j = i - 1; while (j >= 0 && a[j] > x) { a[j + 1] = a[j]; --j; } a[j + 1] = x; } }
+
+// Every rep rebuilds its input from the same seed, so reps differ only in timing noise
+static BenchResult runCase(const BenchCase& c, int n, int reps) {
+    BenchResult r; r.name = c.name; r.n = n;
+    double* perOp = new double[reps];
+    for (int k = 0; k < reps; ++k) {
+        BenchClock clk; long long ops = c.fn(clk, n, BENCH_SEED);
+        perOp[k] = ops > 0 ? clk.ns / ops : 0;
+        if (k == 0) { r.ops = ops; r.allocsPerOp = ops > 0 ? (double)clk.allocs / ops : 0; r.bytesPerOp = ops > 0 ? (double)clk.bytes / ops : 0; r.coreAllocsPerOp = ops > 0 ? (double)clk.core / ops : 0; }
+    }
+    sortDoubles(perOp, reps); r.nsMin = perOp[0]; r.nsMedian = perOp[reps / 2];
+    delete[] perOp;
+    return r;
+}
+
+// ------------- JSON -------------
+// One result object per line, so a previous run can be read back without a JSON parser (see loadBaseline)
+
+static void writeJson(ostream& os, const BenchResult* rs, int cnt, int reps, bool quick) {
+    os << "{\n";
+    os << "  \"suite\": \"courier_bench\",\n";
+    os << "  \"timestamp\": \"" << nowTimestamp() << "\",\n";
+#ifdef __VERSION__
+    os << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+#else
+    os << "  \"compiler\": \"unknown\",\n";
+#endif
+    os << "  \"seed\": " << BENCH_SEED << ",\n";
+    os << "  \"reps\": " << reps << ",\n";
+    os << "  \"quick\": " << (quick ? "true" : "false") << ",\n";
+    os << "  \"metrics_enabled\": " << COURIER_METRICS << ",\n";
+    os << "  \"heap_arity\": " << PARCEL_HEAP_ARITY << ",\n";
+    os << "  \"results\": [\n";
+    for (int i = 0; i < cnt; ++i) {
+        const BenchResult& r = rs[i];
+        os << "    {\"name\": \"" << r.name << "\", \"n\": " << r.n << ", \"ops\": " << r.ops << ", \"ns_per_op\": " << r.nsMedian << ", \"ns_per_op_min\": " << r.nsMin
+            << ", \"allocs_per_op\": " << r.allocsPerOp << ", \"bytes_per_op\": " << r.bytesPerOp << ", \"core_allocs_per_op\": " << r.coreAllocsPerOp << "}"
+            << (i + 1 < cnt ? ",\n" : "\n");
+    }
+    os << "  ]\n}\n";
+}
+
+// Extracts "key": <number> from one result line; false if absent
+static bool jsonNumber(const string& line, const char* key, double& out) {
+    string k = string("\"") + key + "\": "; size_t at = line.find(k); if (at == string::npos) return false;
+    out = atof(line.c_str() + at + k.size()); return true;
+}
+static bool jsonString(const string& line, const char* key, string& out) {
+    string k = string("\"") + key + "\": \""; size_t at = line.find(k); if (at == string::npos) return false;
+    size_t b = at + k.size(), e = line.find('"', b); if (e == string::npos) return false;
+    out = line.substr(b, e - b); return true;
+}
+// ns_per_op of name at input size n in a previous run's JSON, or -1
+static double baselineNs(const char* path, const string& name, int n) {
+    ifstream in(path); string line, nm; double v, vn;
+    while (getline(in, line))
+        if (jsonString(line, "name", nm) && nm == name && jsonNumber(line, "n", vn) && (int)vn == n && jsonNumber(line, "ns_per_op", v)) return v;
+    return -1;
+}
+
+int main(int argc, char** argv) {
+    const char* jsonPath = "courier_bench.json"; const char* baseline = NULL; const char* filter = NULL;
+    int reps = 5; bool quick = false;
+    for (int i = 1; i < argc; ++i) {
+        string a = argv[i];
+        if (a == "--json" && i + 1 < argc) jsonPath = argv[++i];
+        else if (a == "--baseline" && i + 1 < argc) baseline = argv[++i];
+        else if (a == "--filter" && i + 1 < argc) filter = argv[++i];
+        else if (a == "--reps" && i + 1 < argc) { reps = atoi(argv[++i]); if (reps < 1) reps = 1; }
+        else if (a == "--quick") quick = true;
+        else { cerr << "usage: " << argv[0] << " [--json out.json] [--baseline old.json] [--filter name] [--reps N] [--quick]\n"; return 2; }
+    }
+    if (baseline) { ifstream probe(baseline); if (!probe) { cerr << "Cannot read baseline " << baseline << "\n"; return 1; } }
+
+    BenchResult* rs = new BenchResult[NCASES]; int cnt = 0;
+    cout << "case                          n        ns/op (median)   ns/op (min)   allocs/op   bytes/op   core allocs/op" << (baseline ? "   vs baseline" : "") << "\n";
+    for (int i = 0; i < NCASES; ++i) {
+        if (filter && string(CASES[i].name).find(filter) == string::npos) continue;
+        int n = quick ? (CASES[i].n / 10 > 0 ? CASES[i].n / 10 : 1) : CASES[i].n;
+        BenchResult r = runCase(CASES[i], n, reps); rs[cnt++] = r;
+        cout << r.name << string(r.name.size() < 30 ? 30 - r.name.size() : 1, ' ') << r.n << "\t" << r.nsMedian << "\t" << r.nsMin << "\t" << r.allocsPerOp << "\t" << r.bytesPerOp << "\t" << r.coreAllocsPerOp;
+        if (baseline) {
+            double old = baselineNs(baseline, r.name, r.n);
+            if (old > 0) cout << "\t" << (r.nsMedian - old) * 100.0 / old << "%"; else cout << "\t(new)";
+        }
+        cout << "\n";
+    }
+    ofstream out(jsonPath);
+    if (!out) { cerr << "Cannot write " << jsonPath << "\n"; delete[] rs; return 1; }
+    writeJson(out, rs, cnt, reps, quick);
+    cout << "Saved " << cnt << " results to " << jsonPath << " (checksum " << gSink << ")\n";
+    delete[] rs;
+    return 0;
+}
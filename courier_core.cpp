@@ -0,0 +1,5 @@
+// Out-of-line definitions for courier_core.h: everything that must exist exactly once per program.
+#include "courier_core.h"
+
+const char* const ReportWriter::PRIORITY_NAMES[3] = { "Normal", "2-Day", "Overnight" };
+const int ReportWriter::PRIORITY_LENS[3] = { 6, 5, 9 };